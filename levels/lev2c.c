@@ -0,0 +1,336 @@
+/*
+ *  lev2c - indexes & compresses level collections as C source code
+ *  Copyright (C) 1998  Anders Widell  <d95-awi@nada.kth.se>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * This command reads a file in the format of level.data and writes the
+ * file 'data.c' in the current directory, holding
+ *
+ *   level_data         every collection, compressed on its own with zlib,
+ *                      so that one collection can be unpacked without
+ *                      touching the others
+ *   level_collections  for each collection its name, its first level,
+ *                      its number of levels, where its (packed) data is
+ *                      and its content ID
+ *   level_index        for each level where it starts in the unpacked data
+ *                      of its collection, its size, its bounding box, and
+ *                      its orientation and content ID
+ *
+ * The unpacked data of a collection is its levels, each ended by a NUL,
+ * without the collection name. LevelMap.H declares the structures, and
+ * the content IDs are made by ../LevelCode.H, as in the program.
+ */
+
+#include "../../config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#ifdef USE_LIBZ
+#include <zlib.h>
+#else
+typedef unsigned char Bytef;
+typedef unsigned long uLongf;
+#endif
+
+#include "../LevelCode.H"
+
+#define BUFSIZE 16384            /* Increase buffer size by this amount */
+#define MAX_X 61                 /* see Map.H */
+#define MAX_Y 61
+
+struct level {
+  long offset, size;
+  int minX, minY, maxX, maxY;
+  int orientation;
+  unsigned long long id;
+};
+
+struct collection {
+  char *name;
+  int firstLevel, levels;
+  long offset, packedSize, size;
+  unsigned long long id;
+};
+
+static char *source=NULL;        /* The whole input file */
+static long sourceLen=0;
+static char *chunk=NULL;         /* Unpacked data of one collection */
+static long chunkLen;
+static Bytef *dest=NULL;         /* Every packed collection */
+static uLongf destLen=0;
+static uLongf destBufSize=0;
+
+static struct level *levels=NULL;
+static int noOfLevels=0;
+static struct collection *collections=NULL;
+static int noOfCollections=0;
+
+static FILE *outfile=NULL;       /* The output file 'data.c' */
+
+static char *programName="";
+
+/*
+ * Print error message and free allocated resources
+ *
+ */
+
+static int
+error (msg1, msg2, msg3)
+     char *msg1;
+     char *msg2;
+     char *msg3;
+{
+  fprintf (stderr, "%s: %s%s%s\n", programName, msg1, msg2, msg3);
+
+  if (outfile != NULL) fclose (outfile);
+  remove ("data.c");
+  free (source);
+  free (chunk);
+  free (dest);
+  free (levels);
+  free (collections);
+
+  return 1;
+}
+
+/*
+ * Find the bounding box of a level the same way LevelMap::parse does.
+ * Returns 0 if some square is outside the board.
+ *
+ */
+
+static int
+bounds (lev, pos)
+     struct level *lev;
+     char *pos;
+{
+  int x=0, y=0;
+
+  lev->minX = MAX_X;
+  lev->minY = MAX_Y;
+  lev->maxX = lev->maxY = 0;
+
+  for (; *pos; pos++) {
+    switch (*pos) {
+    case '\n':
+      y++;
+      x = 0;
+      break;
+    case '\r':
+      break;
+    case ' ':
+    case '-':
+    case '_':
+      x++;
+      break;
+    case '\t':
+      x = (x+8) & ~7;
+      break;
+    default:
+      if (x > MAX_X || y > MAX_Y) return 0;
+      if (x < lev->minX) lev->minX = x;
+      if (y < lev->minY) lev->minY = y;
+      if (x > lev->maxX) lev->maxX = x;
+      if (y > lev->maxY) lev->maxY = y;
+      x++;
+      break;
+    }
+  }
+  return 1;
+}
+
+/*
+ * Work out the orientation and content ID of a level the same way
+ * LevelStore::identify does.
+ *
+ */
+
+static void
+identify (lev, pos)
+     struct level *lev;
+     char *pos;
+{
+  unsigned char code[LEVEL_CODE_SIZE];
+  int size = levelCode (pos, (int) lev->size, lev->minX, lev->minY, lev->maxX, lev->maxY,
+			code, &lev->orientation);
+  lev->id = levelCodeId (code, size);
+}
+
+/*
+ * Append the data of the current collection, packed, to dest
+ *
+ */
+
+static int
+pack (col)
+     struct collection *col;
+{
+#ifdef USE_LIBZ
+  uLongf len = chunkLen + (chunkLen+9)/10 + 12;
+#else
+  uLongf len = chunkLen;
+#endif
+
+  if (destLen + len > destBufSize) {
+    destBufSize = destLen + len + BUFSIZE;
+    dest = realloc (dest, destBufSize);
+    if (dest == NULL) return 0;
+  }
+
+#ifdef USE_LIBZ
+  if (compress (dest+destLen, &len, (Bytef *) chunk, chunkLen) != Z_OK) return 0;
+#else
+  memcpy (dest+destLen, chunk, chunkLen);
+#endif
+
+  col->offset = destLen;
+  col->packedSize = len;
+  col->size = chunkLen;
+  destLen += len;
+  return 1;
+}
+
+int
+main (argc, argv)
+     int argc;
+     char **argv;
+{
+  FILE *infile;
+  long sourceBufSize=0, pos, j;
+  int i, newLevel;
+  struct collection *col=NULL;
+
+  programName = argv[0];
+  if (argc != 2) {
+    fprintf (stderr, "usage: %s level.data\n", argv[0]);
+    return 1;
+  }
+
+  infile = fopen (argv[1], "rb");
+  if (infile == NULL) return error ("can't open '", argv[1], "' for reading");
+  while (!feof (infile)) {
+    if (sourceLen + BUFSIZE + 1 > sourceBufSize) {
+      sourceBufSize += BUFSIZE + 1;
+      source = realloc (source, sourceBufSize);
+      if (source == NULL) return error ("memory exhausted", "", "");
+    }
+    sourceLen += fread (source+sourceLen, 1, BUFSIZE, infile);
+    if (ferror (infile)) {
+      fclose (infile);
+      return error ("error reading '", argv[1], "'");
+    }
+  }
+  fclose (infile);
+  source[sourceLen] = '\0';
+
+  /* Count the levels (each ends with a NUL) and the collections */
+  noOfLevels = 0;
+  for (j=0; j<sourceLen; j++) if (source[j] == '\0') noOfLevels++;
+  levels = malloc ((noOfLevels+1) * sizeof (struct level));
+  collections = malloc ((noOfLevels+1) * sizeof (struct collection));
+  chunk = malloc (sourceLen+1);
+  if (levels == NULL || collections == NULL || chunk == NULL)
+    return error ("memory exhausted", "", "");
+
+  /* Split the file into collections, the same way LevelMap did */
+  pos = 0;
+  chunkLen = 0;
+  for (i=0; i<noOfLevels; i++) {
+    while (source[pos] == '\n') pos++;
+    newLevel = isalpha (source[pos]);
+    if (newLevel) {
+      if (col != NULL && !pack (col)) return error ("error compressing '", argv[1], "'");
+      col = &collections[noOfCollections++];
+      col->name = source+pos;
+      col->firstLevel = i;
+      col->levels = 0;
+      while (source[pos] != '\n' && source[pos] != '\0') pos++;
+      if (source[pos] == '\0') return error ("collection without levels in '", argv[1], "'");
+      source[pos++] = '\0';
+      chunkLen = 0;
+    }
+    if (col == NULL) return error ("level before the first collection name in '", argv[1], "'");
+
+    levels[i].offset = chunkLen;
+    levels[i].size = strlen (source+pos);
+    if (!bounds (&levels[i], source+pos)) return error ("level too large in '", argv[1], "'");
+    identify (&levels[i], source+pos);
+    memcpy (chunk+chunkLen, source+pos, levels[i].size+1);
+    chunkLen += levels[i].size+1;
+    pos += levels[i].size+1;
+    col->levels++;
+  }
+  if (col == NULL) return error ("no level collections found in '", argv[1], "'");
+  if (!pack (col)) return error ("error compressing '", argv[1], "'");
+
+  outfile = fopen ("data.c", "w");
+  if (outfile == NULL) return error ("can't open 'data.c' for writing", "", "");
+
+  fprintf (outfile, "static const unsigned char level_data[] = {\n");
+  for (j=0; j<(long)destLen; j++) {
+    fprintf (outfile, "%s0x%02x%s", j%8 == 0 ? "  " : "",
+	     ((unsigned) dest[j]) & 0xffu,
+	     j == (long)destLen-1 ? "\n" : (j%8 == 7 ? ",\n" : ", "));
+  }
+  fprintf (outfile, "};\n\n");
+
+  fprintf (outfile, "static const LevelCollection level_collections[] = {\n");
+  for (i=0; i<noOfCollections; i++) {
+    char *p;
+    col = &collections[i];
+    col->id = LEVEL_CODE_BASIS;
+    for (j=0; j<col->levels; j++) {
+      struct level *lev = &levels[col->firstLevel+j];
+      col->id = levelCodeAdd (col->id, lev->id, lev->orientation);
+    }
+    col->id = levelCodeEnd (col->id);
+    fprintf (outfile, "  { \"");
+    for (p=col->name; *p; p++) {
+      if (*p == '"' || *p == '\\') fputc ('\\', outfile);
+      fputc (*p, outfile);
+    }
+    fprintf (outfile, "\", %d, %d, %ld, %ld, %ld, 0x%016llxULL }%s\n", col->firstLevel,
+	     col->levels, col->offset, col->packedSize, col->size, col->id,
+	     i == noOfCollections-1 ? "" : ",");
+  }
+  fprintf (outfile, "};\n\n");
+
+  fprintf (outfile, "static const LevelIndex level_index[] = {\n");
+  for (i=0; i<noOfLevels; i++) {
+    fprintf (outfile, "  { %ld, %ld, %d, %d, %d, %d, %d, 0x%016llxULL }%s\n",
+	     levels[i].offset, levels[i].size, levels[i].minX, levels[i].minY,
+	     levels[i].maxX, levels[i].maxY, levels[i].orientation, levels[i].id,
+	     i == noOfLevels-1 ? "" : ",");
+  }
+  fprintf (outfile, "};\n");
+
+  if (ferror (outfile)) return error ("error writing 'data.c'", "", "");
+  fclose (outfile);
+  outfile = NULL;
+
+  free (source);
+  free (chunk);
+  free (dest);
+  free (levels);
+  free (collections);
+
+  return 0;
+}